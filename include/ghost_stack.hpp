@@ -1,9 +1,12 @@
 #pragma once
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <vector>
+#ifndef GHOST_STACK_INSTRUMENT
 #define UNW_LOCAL_ONLY
 #include <libunwind.h>
+#endif
 
 struct StackEntry {
   uintptr_t return_address; // Original return address
@@ -12,17 +15,90 @@ struct StackEntry {
   uintptr_t ip;             // Instruction pointer when the trace was taken
 };
 
+// Plain snapshot of the GhostStack counters
+struct GhostStackStats {
+  uint64_t unwinds = 0;            // Calls to unwind()
+  uint64_t frames_walked = 0;      // Frames walked with libunwind
+  uint64_t frames_reused = 0;      // Frames taken from the shadow stack
+  uint64_t trampoline_returns = 0; // Returns through the trampoline
+  uint64_t exception_resyncs = 0;  // Exceptions thrown through a trampoline
+  uint64_t resets = 0;             // Calls to reset()
+  uint64_t mprotect_calls = 0;     // mprotect() calls on stack pages
+  uint64_t truncated_unwinds = 0;  // Unwinds that lost outermost frames
+
+  GhostStackStats &operator+=(const GhostStackStats &other);
+};
+
+// Per-thread counters. Only the owning thread writes them, so updates are
+// relaxed load/store pairs; other threads may read them at any time.
+struct GhostStackCounters {
+  std::atomic<uint64_t> unwinds{0};
+  std::atomic<uint64_t> frames_walked{0};
+  std::atomic<uint64_t> frames_reused{0};
+  std::atomic<uint64_t> trampoline_returns{0};
+  std::atomic<uint64_t> exception_resyncs{0};
+  std::atomic<uint64_t> resets{0};
+  std::atomic<uint64_t> mprotect_calls{0};
+  std::atomic<uint64_t> truncated_unwinds{0};
+
+  GhostStackCounters();  // Registers with the process-wide aggregate
+  ~GhostStackCounters(); // Folds the counts into the process-wide aggregate
+  GhostStackCounters(const GhostStackCounters &) = delete;
+  GhostStackCounters &operator=(const GhostStackCounters &) = delete;
+
+  static void add(std::atomic<uint64_t> &counter, uint64_t n = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + n,
+                  std::memory_order_relaxed);
+  }
+  GhostStackStats snapshot() const;
+};
+
 class GhostStack {
 public:
   static GhostStack &get();
+#ifndef GHOST_STACK_INSTRUMENT
   uintptr_t on_ret_trampoline(uintptr_t stack_pointer);
+  uintptr_t on_exception_through_trampoline();
   void capture_stack_trace(bool install_trampolines);
   const std::vector<uintptr_t> unwind(bool install_trampolines = true);
+#else
+  // Always inlined so that __builtin_return_address(0) is the return address
+  // of the function calling unwind(), which may not be instrumented itself.
+  // Only the innermost GHOST_STACK_INSTRUMENT_MAX_FRAMES frames are kept;
+  // deeper stacks lose their outermost frames (see truncated_unwinds).
+  __attribute__((always_inline, no_instrument_function))
+  const std::vector<uintptr_t> unwind(bool install_trampolines = true) {
+    (void)install_trampolines;
+    return unwind_from((uintptr_t)__builtin_return_address(0));
+  }
+#endif
+  // Drop cached state; the next unwind() still reports the whole stack. The
+  // trampoline engine restores the patched return addresses and walks again,
+  // the instrument engine has no cache. Neither engine supports longjmp()
+  // across captured frames.
   void reset();
+  // Mark the calling function as the root of the calling thread; captures
+  // never walk past it. Must be called directly from the root function's own
+  // body with its __builtin_frame_address(0): the trampoline engine anchors
+  // at frame_address, the instrument engine at the current call depth.
+  // Does not create the thread's GhostStack.
+  static void set_root(uintptr_t frame_address);
+
+  // Counters of the calling thread
+  GhostStackStats stats() const { return counters.snapshot(); }
+  // Counters summed over all live and exited threads
+  static GhostStackStats aggregate_stats();
 
 private:
   GhostStack() = default;
+#ifndef GHOST_STACK_INSTRUMENT
+  uintptr_t pop_entry(uintptr_t stack_pointer);
+  void restore_entries();
   std::vector<StackEntry> entries;
   size_t location = 0;
+#else
+  const std::vector<uintptr_t> unwind_from(uintptr_t leaf);
+#endif
+  GhostStackCounters counters;
   static thread_local std::unique_ptr<GhostStack> instance;
 };
@@ -0,0 +1,20 @@
+#!/bin/bash
+set -e
+
+# Get the directory of this script
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+PROJECT_DIR="$( cd "$SCRIPT_DIR/.." && pwd )"
+
+# Build outside of the source tree and clean up afterwards
+BUILD_ROOT="$(mktemp -d)"
+trap 'rm -rf "$BUILD_ROOT"' EXIT
+
+# Build and run the same unwind benchmark against every GhostStack engine
+for backend in trampoline instrument; do
+    build_dir="$BUILD_ROOT/$backend"
+    cmake -S "$PROJECT_DIR" -B "$build_dir" -DGHOST_STACK_BACKEND="$backend" > /dev/null
+    cmake --build "$build_dir" --target ghost_stack_unwind_bench > /dev/null
+
+    echo "=== $backend ==="
+    "$build_dir/ghost_stack_unwind_bench"
+done
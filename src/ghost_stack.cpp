@@ -18,9 +18,10 @@ uintptr_t nwind_on_ret_trampoline(uintptr_t stack_pointer) {
 }
 
 uintptr_t nwind_on_exception_through_trampoline(void *exception) {
+#ifdef DEBUG
   printf("Oh no!\n");
-  uintptr_t return_addr = GhostStack::get().on_ret_trampoline(0);
-  GhostStack::get().reset();
+#endif
+  uintptr_t return_addr = GhostStack::get().on_exception_through_trampoline();
   __cxxabiv1::__cxa_begin_catch(exception);
   return return_addr;
 }
@@ -28,6 +29,9 @@ uintptr_t nwind_on_exception_through_trampoline(void *exception) {
 
 thread_local std::unique_ptr<GhostStack> GhostStack::instance;
 
+// Root frame address of this thread, 0 if none was registered
+static thread_local uintptr_t root = 0;
+
 GhostStack &GhostStack::get() {
   if (!instance) {
     instance = std::unique_ptr<GhostStack>(new GhostStack());
@@ -74,6 +78,19 @@ std::string symbolize_address(unw_word_t addr) {
 }
 
 uintptr_t GhostStack::on_ret_trampoline(uintptr_t stack_pointer) {
+  GhostStackCounters::add(counters.trampoline_returns);
+  return pop_entry(stack_pointer);
+}
+
+uintptr_t GhostStack::on_exception_through_trampoline() {
+  // Only counted as a resync, not as a trampoline return and a reset
+  GhostStackCounters::add(counters.exception_resyncs);
+  uintptr_t return_addr = pop_entry(0);
+  restore_entries();
+  return return_addr;
+}
+
+uintptr_t GhostStack::pop_entry(uintptr_t stack_pointer) {
   if (entries.empty()) {
     std::cerr << "Ghost stack underflow!" << std::endl;
     std::abort();
@@ -99,8 +116,10 @@ uintptr_t GhostStack::on_ret_trampoline(uintptr_t stack_pointer) {
   }
   auto ret_addr = entry.return_address;
 
+#ifdef DEBUG
   // Print symbolized return address
   std::cout << "Returning to: " << symbolize_address(ret_addr) << std::endl;
+#endif
 
   return ret_addr;
 }
@@ -172,21 +191,33 @@ void GhostStack::capture_stack_trace(bool install_trampolines) {
     uintptr_t *ret_addr_loc = (uintptr_t*)(fp + sizeof(void*));
 #endif
 
+    // The return address saved by the root frame (right above its frame
+    // record) leads into libc's thread startup code, which we never need to
+    // walk or patch
+    if (root && (uintptr_t)ret_addr_loc == root + sizeof(void *)) {
+      break;
+    }
+
     // Now saveLoc points to the return address location for the previous frame
-    printf("Return addr loc is: %p\n", ret_addr_loc);
     uintptr_t ret_addr = *ret_addr_loc;
+#ifdef DEBUG
+    printf("Return addr loc is: %p\n", ret_addr_loc);
     std::cout << "Return addr is: " << symbolize_address(ret_addr) << std::endl;
+#endif
 
     // Check for existing trampoline
     if (ret_addr == (uintptr_t)nwind_ret_trampoline) {
       found_existing_frame = true;
+#ifdef DEBUG
       std::cout << "Found already patched frame, stopping capture\n";
+#endif
       break;
     }
 
     // Make the page containing the return address writable
     uintptr_t page_start = (uintptr_t)ret_addr_loc & ~(0xFFF);
     mprotect((void *)page_start, 0x1000, PROT_READ | PROT_WRITE);
+    GhostStackCounters::add(counters.mprotect_calls);
 
     ip = ptrauth_strip(ip, 0);
 
@@ -197,7 +228,7 @@ void GhostStack::capture_stack_trace(bool install_trampolines) {
     unw_get_reg(&cursor, SP_REGISTER, &fp);
   }
 
-  std::cerr << "Using 100% of " << new_entries.size() << " frames" << std::endl;
+  GhostStackCounters::add(counters.frames_walked, new_entries.size());
 
   // Install trampolines for new entries
   if (install_trampolines && new_entries.size()) {
@@ -217,10 +248,7 @@ void GhostStack::capture_stack_trace(bool install_trampolines) {
 
   // Handle merging if we found existing frame
   if (found_existing_frame && !entries.empty()) {
-    size_t total = entries.size() + new_entries.size();
-    std::cerr << "Using " << (entries.size() * 100.0f / total)
-              << "% of existing frames" << std::endl;
-
+    GhostStackCounters::add(counters.frames_reused, entries.size() - location);
     new_entries.insert(new_entries.end(), entries.begin() + location,
                       entries.end());
   }
@@ -233,13 +261,17 @@ void GhostStack::capture_stack_trace(bool install_trampolines) {
 // New function to get current stack trace using ghost stack
 __attribute__((noinline)) 
 const std::vector<uintptr_t> GhostStack::unwind(bool install_trampolines) {
+  GhostStackCounters::add(counters.unwinds);
+
   // First ensure all frames are patched
   capture_stack_trace(install_trampolines);
 
   // Create vector of return addresses in correct order
   std::vector<uintptr_t> stack_trace;
   for (const auto &entry : entries) {
-  std::cout << "STACK : " << symbolize_address(entry.return_address) << std::endl;
+#ifdef DEBUG
+    std::cout << "STACK : " << symbolize_address(entry.return_address) << std::endl;
+#endif
     stack_trace.push_back(entry.return_address);
   }
 
@@ -247,6 +279,11 @@ const std::vector<uintptr_t> GhostStack::unwind(bool install_trampolines) {
 }
 
 void GhostStack::reset() {
+  GhostStackCounters::add(counters.resets);
+  restore_entries();
+}
+
+void GhostStack::restore_entries() {
   // Restore all original return addresses
   for (size_t i = location; i < entries.size(); i++) {
     auto &entry = entries[i];
@@ -254,3 +291,5 @@ void GhostStack::reset() {
   }
   entries.clear();
 }
+
+void GhostStack::set_root(uintptr_t frame_address) { root = frame_address; }
@@ -0,0 +1,108 @@
+// GhostStack engine driven by -finstrument-functions hooks.
+//
+// Instead of patching return addresses, every instrumented function pushes
+// its call site on entry and pops it on exit. The per-thread array is a ring
+// filled from the end towards the beginning, so the innermost kMaxFrames
+// frames are kept in innermost-first order and unwind() is at most two
+// contiguous copies.
+#include "ghost_stack.hpp"
+#include <algorithm>
+#include <cstddef>
+
+#ifndef GHOST_STACK_INSTRUMENT_MAX_FRAMES
+#define GHOST_STACK_INSTRUMENT_MAX_FRAMES 4096
+#endif
+
+namespace {
+
+constexpr size_t kMaxFrames = GHOST_STACK_INSTRUMENT_MAX_FRAMES;
+
+struct ShadowStack {
+  uintptr_t frames[kMaxFrames];
+  size_t depth; // May exceed kMaxFrames; outermost frames are overwritten
+  size_t root_depth; // Depth when the root frame was registered
+};
+
+// initial-exec avoids __tls_get_addr in the hooks. This is fine for
+// executables and LD_PRELOAD libraries but not for late dlopen().
+__attribute__((tls_model("initial-exec"))) thread_local ShadowStack shadow;
+
+// Slot of the frame at the given depth
+__attribute__((no_instrument_function)) inline size_t slot(size_t depth) {
+  return kMaxFrames - 1 - depth % kMaxFrames;
+}
+
+} // namespace
+
+extern "C" {
+
+__attribute__((no_instrument_function)) void
+__cyg_profile_func_enter(void *this_fn, void *call_site) {
+  (void)this_fn;
+  ShadowStack &stack = shadow;
+  stack.frames[slot(stack.depth)] = (uintptr_t)call_site;
+  stack.depth++;
+}
+
+// GCC also runs this hook when an exception unwinds through an instrumented
+// frame, so the shadow stack stays in sync without a resync path. Clang only
+// calls it before returning, which is why CMake requires GCC for this engine.
+__attribute__((no_instrument_function)) void
+__cyg_profile_func_exit(void *this_fn, void *call_site) {
+  (void)this_fn;
+  (void)call_site;
+  ShadowStack &stack = shadow;
+  if (stack.depth > 0) {
+    stack.depth--;
+  }
+}
+}
+
+thread_local std::unique_ptr<GhostStack> GhostStack::instance;
+
+GhostStack &GhostStack::get() {
+  if (!instance) {
+    instance = std::unique_ptr<GhostStack>(new GhostStack());
+  }
+  return *instance;
+}
+
+// The shadow stack is always up to date, so there is nothing to install.
+// The hooks only record call sites, so the return address of the function
+// calling unwind() (leaf) is prepended unless that function is instrumented
+// and already pushed it.
+const std::vector<uintptr_t> GhostStack::unwind_from(uintptr_t leaf) {
+  size_t depth = shadow.depth;
+  size_t frames = depth - std::min(shadow.root_depth, depth);
+  GhostStackCounters::add(counters.unwinds);
+  if (frames > kMaxFrames) {
+    frames = kMaxFrames;
+    GhostStackCounters::add(counters.truncated_unwinds);
+  }
+  GhostStackCounters::add(counters.frames_reused, frames);
+
+  // Innermost frames run up to the end of the array, then wrap around
+  const uintptr_t *top = frames ? shadow.frames + slot(depth - 1) : nullptr;
+  size_t first = std::min(frames, (size_t)(shadow.frames + kMaxFrames - top));
+
+  std::vector<uintptr_t> stack_trace;
+  stack_trace.reserve(frames + 1);
+  if (frames == 0 || top[0] != leaf) {
+    stack_trace.push_back(leaf);
+  }
+  stack_trace.insert(stack_trace.end(), top, top + first);
+  stack_trace.insert(stack_trace.end(), shadow.frames,
+                     shadow.frames + (frames - first));
+  return stack_trace;
+}
+
+// The exit hooks keep the shadow stack in sync, so there is no cache to drop.
+void GhostStack::reset() { GhostStackCounters::add(counters.resets); }
+
+// Frames are recorded by depth, so the root is wherever the shadow stack
+// currently ends. This is why set_root() must be called from the root
+// function itself; the frame address is not needed.
+void GhostStack::set_root(uintptr_t frame_address) {
+  (void)frame_address;
+  shadow.root_depth = shadow.depth;
+}
@@ -0,0 +1,68 @@
+#include "ghost_stack.hpp"
+#include <algorithm>
+#include <mutex>
+
+namespace {
+
+struct StatsRegistry {
+  std::mutex mutex;
+  std::vector<const GhostStackCounters *> live;
+  GhostStackStats retired; // Counts of threads that already exited
+};
+
+// Leaked on purpose so thread exits during process teardown can still use it
+StatsRegistry &registry() {
+  static StatsRegistry *instance = new StatsRegistry();
+  return *instance;
+}
+
+} // namespace
+
+GhostStackStats &GhostStackStats::operator+=(const GhostStackStats &other) {
+  unwinds += other.unwinds;
+  frames_walked += other.frames_walked;
+  frames_reused += other.frames_reused;
+  trampoline_returns += other.trampoline_returns;
+  exception_resyncs += other.exception_resyncs;
+  resets += other.resets;
+  mprotect_calls += other.mprotect_calls;
+  truncated_unwinds += other.truncated_unwinds;
+  return *this;
+}
+
+GhostStackCounters::GhostStackCounters() {
+  auto &reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  reg.live.push_back(this);
+}
+
+GhostStackCounters::~GhostStackCounters() {
+  auto &reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  reg.live.erase(std::remove(reg.live.begin(), reg.live.end(), this),
+                 reg.live.end());
+  reg.retired += snapshot();
+}
+
+GhostStackStats GhostStackCounters::snapshot() const {
+  GhostStackStats stats;
+  stats.unwinds = unwinds.load(std::memory_order_relaxed);
+  stats.frames_walked = frames_walked.load(std::memory_order_relaxed);
+  stats.frames_reused = frames_reused.load(std::memory_order_relaxed);
+  stats.trampoline_returns = trampoline_returns.load(std::memory_order_relaxed);
+  stats.exception_resyncs = exception_resyncs.load(std::memory_order_relaxed);
+  stats.resets = resets.load(std::memory_order_relaxed);
+  stats.mprotect_calls = mprotect_calls.load(std::memory_order_relaxed);
+  stats.truncated_unwinds = truncated_unwinds.load(std::memory_order_relaxed);
+  return stats;
+}
+
+GhostStackStats GhostStack::aggregate_stats() {
+  auto &reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  GhostStackStats total = reg.retired;
+  for (const auto *counters : reg.live) {
+    total += counters->snapshot();
+  }
+  return total;
+}
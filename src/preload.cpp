@@ -1,5 +1,6 @@
 #define _GNU_SOURCE
 #include "ghost_stack.hpp"
+#include <cstdlib>
 #include <ctime>
 #include <dlfcn.h>
 #include <iomanip>
@@ -18,6 +19,59 @@ static real_read_t real_read = nullptr;
 // Mutex for thread-safe logging
 static pthread_mutex_t print_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+// Print the process-wide GhostStack counters
+static void dump_stats() {
+  auto stats = GhostStack::aggregate_stats();
+  pthread_mutex_lock(&print_mutex);
+  std::cerr << "=== GhostStack stats ===" << std::endl
+            << "unwinds: " << stats.unwinds << std::endl
+            << "frames walked: " << stats.frames_walked << std::endl
+            << "frames reused: " << stats.frames_reused << std::endl
+            << "trampoline returns: " << stats.trampoline_returns << std::endl
+            << "exception resyncs: " << stats.exception_resyncs << std::endl
+            << "resets: " << stats.resets << std::endl
+            << "mprotect calls: " << stats.mprotect_calls << std::endl
+            << "truncated unwinds: " << stats.truncated_unwinds << std::endl;
+  pthread_mutex_unlock(&print_mutex);
+}
+
+static void *stats_thread(void *arg) {
+  unsigned int interval = (unsigned int)(uintptr_t)arg;
+  while (true) {
+    sleep(interval);
+    dump_stats();
+  }
+  return nullptr;
+}
+
+// Dump the counters every GHOST_STACK_STATS_INTERVAL seconds, if set
+static void start_stats_dump() {
+  const char *env = getenv("GHOST_STACK_STATS_INTERVAL");
+  if (!env) {
+    return;
+  }
+  int interval = atoi(env);
+  if (interval <= 0) {
+    std::cerr << "Invalid GHOST_STACK_STATS_INTERVAL: " << env << std::endl;
+    return;
+  }
+  pthread_t thread;
+  if (pthread_create(&thread, nullptr, stats_thread,
+                     (void *)(uintptr_t)interval) != 0) {
+    std::cerr << "Failed to start GhostStack stats thread" << std::endl;
+    return;
+  }
+  pthread_detach(thread);
+  atexit(dump_stats);
+}
+
+// Type for real pthread_create function
+typedef int (*real_pthread_create_t)(pthread_t *thread,
+                                     const pthread_attr_t *attr,
+                                     void *(*start_routine)(void *), void *arg);
+
+static real_pthread_create_t real_pthread_create = nullptr;
+
 // Initialize when library is loaded
 __attribute__((constructor)) static void init() {
   // Get the real read function
@@ -27,6 +81,18 @@ __attribute__((constructor)) static void init() {
     abort();
   }
 
+  // Get the real pthread_create function
+  real_pthread_create =
+      (real_pthread_create_t)dlsym(RTLD_NEXT, "pthread_create");
+  if (!real_pthread_create) {
+    std::cerr << "Failed to get real pthread_create function: " << dlerror()
+              << std::endl;
+    abort();
+  }
+
+  // init() may also run from read() or pthread_create() on any thread
+  static pthread_once_t stats_once = PTHREAD_ONCE_INIT;
+  pthread_once(&stats_once, start_stats_dump);
 }
 
 // Our intercepted read function
@@ -60,3 +126,73 @@ extern "C" ssize_t read(int fd, void *buf, size_t count) {
 
   return result;
 }
+
+// Start routine and argument of a thread created through our pthread_create
+struct ThreadStart {
+  void *(*start_routine)(void *);
+  void *arg;
+};
+
+// Root frame of every thread: captures stop here instead of walking through
+// start_thread and clone. Sibling calls must stay off so this frame is live.
+__attribute__((noinline, optimize("no-optimize-sibling-calls"))) static void *
+thread_root(void *arg) {
+  auto *start = static_cast<ThreadStart *>(arg);
+  auto start_routine = start->start_routine;
+  auto start_arg = start->arg;
+  delete start;
+
+  GhostStack::set_root((uintptr_t)__builtin_frame_address(0));
+  return start_routine(start_arg);
+}
+
+// Our intercepted pthread_create function
+extern "C" int pthread_create(pthread_t *thread, const pthread_attr_t *attr,
+                              void *(*start_routine)(void *), void *arg) {
+  if (!real_pthread_create) {
+    init();
+  }
+  auto *start = new ThreadStart{start_routine, arg};
+  int result = real_pthread_create(thread, attr, thread_root, start);
+  if (result != 0) {
+    delete start;
+  }
+  return result;
+}
+
+#ifdef __linux__
+// Types for main and the real __libc_start_main function
+typedef int (*main_t)(int argc, char **argv, char **envp);
+typedef int (*real_libc_start_main_t)(main_t main, int argc, char **argv,
+                                      void (*init)(void), void (*fini)(void),
+                                      void (*rtld_fini)(void),
+                                      void *stack_end);
+
+static main_t real_main = nullptr;
+
+// Root frame of the main thread, see thread_root
+__attribute__((noinline, optimize("no-optimize-sibling-calls"))) static int
+main_root(int argc, char **argv, char **envp) {
+  GhostStack::set_root((uintptr_t)__builtin_frame_address(0));
+  return real_main(argc, argv, envp);
+}
+
+// Wrap main in a root frame when GHOST_STACK_ANCHOR_MAIN is set
+extern "C" int __libc_start_main(main_t main, int argc, char **argv,
+                                 void (*init)(void), void (*fini)(void),
+                                 void (*rtld_fini)(void), void *stack_end) {
+  auto real_libc_start_main =
+      (real_libc_start_main_t)dlsym(RTLD_NEXT, "__libc_start_main");
+  if (!real_libc_start_main) {
+    std::cerr << "Failed to get real __libc_start_main function: " << dlerror()
+              << std::endl;
+    abort();
+  }
+  if (getenv("GHOST_STACK_ANCHOR_MAIN")) {
+    real_main = main;
+    main = main_root;
+  }
+  return real_libc_start_main(main, argc, argv, init, fini, rtld_fini,
+                              stack_end);
+}
+#endif
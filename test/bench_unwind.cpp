@@ -0,0 +1,76 @@
+#include "ghost_stack.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+// Times GhostStack::unwind() alone, without the preload library's logging,
+// so that the trampoline and instrument engines can be compared directly.
+
+static size_t frames_seen = 0;
+
+// Leaf that unwinds; with the trampoline engine its return goes through the
+// trampoline, like any function calling unwind() from a hot path.
+__attribute__((noinline)) static double timed_unwind() {
+  auto start = std::chrono::steady_clock::now();
+  auto trace = GhostStack::get().unwind();
+  auto end = std::chrono::steady_clock::now();
+  frames_seen = trace.size();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+             .count() /
+         1000.0;
+}
+
+__attribute__((noinline, optimize("no-optimize-sibling-calls"))) int
+recursive_function(int depth) {
+  if (depth == 0) {
+    // First unwinding
+    double first_unwind_us = timed_unwind();
+    std::cout << "First unwind duration: " << first_unwind_us
+              << " microseconds (" << frames_seen << " frames)" << std::endl;
+
+    // Warm-up run
+    for (int i = 0; i < 100; i++) {
+      timed_unwind();
+    }
+
+    // Actual timing
+    const int N = 10000; // Number of unwinding iterations
+    std::vector<double> unwind_times;
+    unwind_times.reserve(N);
+    for (int i = 0; i < N; i++) {
+      unwind_times.push_back(timed_unwind());
+    }
+
+    // Calculate statistics
+    double sum = std::accumulate(unwind_times.begin(), unwind_times.end(), 0.0);
+    double mean = sum / N;
+    std::sort(unwind_times.begin(), unwind_times.end());
+    double median = (unwind_times[N / 2 - 1] + unwind_times[N / 2]) / 2;
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "\nUnwind Statistics (microseconds):\n"
+              << "  Mean:   " << mean << "\n"
+              << "  Median: " << median << "\n"
+              << "  Min:    " << unwind_times.front() << "\n"
+              << "  Max:    " << unwind_times.back() << "\n"
+              << "  Frames: " << frames_seen << "\n"
+              << "  Samples:" << N << std::endl;
+    return 42;
+  }
+  return recursive_function(depth - 1) + 1;
+}
+
+int main() {
+  const int RECURSION_DEPTH = 1000;
+  GhostStack::set_root((uintptr_t)__builtin_frame_address(0));
+  std::cout << "Unwinding at recursion depth " << RECURSION_DEPTH << std::endl;
+  recursive_function(RECURSION_DEPTH);
+
+  auto stats = GhostStack::get().stats();
+  std::cout << "Frames walked: " << stats.frames_walked
+            << ", frames reused: " << stats.frames_reused << std::endl;
+  return 0;
+}
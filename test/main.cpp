@@ -1,14 +1,33 @@
 #include "ghost_stack.hpp"
+#include <cstdlib>
 #include <exception>
 #include <iostream>
+#include <thread>
+
+static void check(bool condition, const char *what) {
+  if (!condition) {
+    std::cerr << "Check failed: " << what << std::endl;
+    std::abort();
+  }
+}
+
+// Both engines must report function3's return address first and stop at the
+// root registered in main: function3 -> function2 -> function1 -> main.
+static void check_trace(const std::vector<uintptr_t> &trace,
+                        uintptr_t return_address) {
+  check(trace.size() == 3, "trace has one frame per call up to main");
+  check(trace[0] == return_address, "innermost frame is the caller's");
+}
 
 __attribute__((noinline)) int function3() {
   std::cout << "In function3, capturing stack trace..." << std::endl;
-  GhostStack::get().unwind(true);
+  // Read before unwinding, the trampoline engine patches this slot
+  auto return_address = (uintptr_t)__builtin_return_address(0);
+  check_trace(GhostStack::get().unwind(true), return_address);
   // std::cout << "Stack trace captured..." << std::endl;
   const auto &ex = std::exception();
   // std::cerr << "Exception addr: " << (const void *)&ex << std::endl;
-  GhostStack::get().unwind();
+  check_trace(GhostStack::get().unwind(), return_address);
   throw ex;
   // std::cout << "Second Stack trace captured..." << std::endl;
   return 42;
@@ -34,6 +53,7 @@ __attribute__((noinline)) int function1() {
 }
 
 int main() {
+  GhostStack::set_root((uintptr_t)__builtin_frame_address(0));
   std::cout << "In main" << std::endl;
   int res = 0;
   try {
@@ -43,6 +63,29 @@ int main() {
     std::cout << "Recovered!" << std::endl; // This will go through trampoline
   }
   std::cout << "Back in main" << std::endl; // This will go through trampoline
+
+  // function3 unwound twice on this thread, and this is the only thread
+  auto stats = GhostStack::get().stats();
+  check(stats.unwinds == 2, "unwinds counts every unwind() call");
+#ifndef GHOST_STACK_INSTRUMENT
+  // The first unwind walks the 3 frames up to main, the second reuses them
+  check(stats.frames_walked == 3, "first unwind walks every frame");
+  check(stats.frames_reused == 3, "second unwind reuses every frame");
+  // The exception went through function3's trampoline exactly once
+  check(stats.exception_resyncs == 1, "exception counts as one resync");
+  check(stats.resets == 0, "exception resync is not counted as reset()");
+#else
+  check(stats.frames_walked == 0, "instrument engine never walks frames");
+  check(stats.frames_reused == 6, "every frame comes from the shadow stack");
+#endif
+  check(GhostStack::aggregate_stats().unwinds == stats.unwinds,
+        "aggregate includes the main thread");
+
+  // Counters of exited threads must stay in the aggregate
+  std::thread thread([] { GhostStack::get().unwind(); });
+  thread.join();
+  check(GhostStack::aggregate_stats().unwinds == stats.unwinds + 1,
+        "aggregate includes exited threads");
   std::cout << "Result: " << res
             << std::endl; // This will go through trampoline
   return 0;